@@ -0,0 +1,171 @@
+/**
+* Copyright (c) 2020 LG Electronics, Inc.
+*
+* Unless otherwise specified or set forth in the NOTICE file, all content,
+* including all source code files and documentation files in this repository are:
+* Confidential computer software. Valid license from LG required for
+* possession, use or copying.
+*/
+
+/**
+ *@file         AllocationTest.cpp
+ *@brief        Counts heap allocations per Feed() of LG_EsRecorder and LG_EsReplayer in steady state.
+ *@details      malloc/calloc/realloc and the aligned allocators are interposed, which also covers operator new.\n
+ *              The budgets are given by ALLOCATION_BUDGET_RECORD and ALLOCATION_BUDGET_REPLAY (see CMakeLists.txt).
+ */
+
+#include <cerrno>
+#include <vector>
+
+#include "LG_EsRecorder.h"
+#include "StubEsPlayer.h"
+
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void* __libc_valloc(size_t size);
+extern "C" void* __libc_pvalloc(size_t size);
+extern "C" void  __libc_free(void* ptr);
+
+static std::atomic<long> gAllocations { 0 };
+
+extern "C" void* malloc (size_t size)
+{
+	++gAllocations;
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc (size_t count, size_t size)
+{
+	++gAllocations;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc (void* ptr, size_t size)
+{
+	++gAllocations;
+	return __libc_realloc(ptr, size);
+}
+
+extern "C" void* memalign (size_t alignment, size_t size)
+{
+	++gAllocations;
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" void* aligned_alloc (size_t alignment, size_t size)
+{
+	++gAllocations;
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign (void** ptr, size_t alignment, size_t size)
+{
+	++gAllocations;
+	if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+		return EINVAL;
+	void* allocated = __libc_memalign(alignment, size);
+	if (!allocated && size != 0)
+		return ENOMEM;
+	*ptr = allocated;
+	return 0;
+}
+
+extern "C" void* valloc (size_t size)
+{
+	++gAllocations;
+	return __libc_valloc(size);
+}
+
+extern "C" void* pvalloc (size_t size)
+{
+	++gAllocations;
+	return __libc_pvalloc(size);
+}
+
+extern "C" void free (void* ptr)
+{
+	__libc_free(ptr);
+}
+
+
+static const int kWarmup = 16;
+static const int kSamples = 1000;
+
+/**
+ *@brief		A stand-in player which counts the allocations made between its Feed() calls.
+ */
+class CountingEsPlayer : public StubEsPlayer
+{
+public:
+	virtual int Feed (const uint8_t *data, uint32_t size, int64_t pts, estream_t type) const override
+	{
+		const int feed = ++feeds;
+		if (feed == kWarmup)
+			allocationsAtWarmup = gAllocations;
+		allocationsAtLast = gAllocations;
+		lastData = data;
+		lastSize = size;
+		lastPts = pts;
+		(void)type;
+		return LG_SUCCESS;
+	}
+
+	mutable int     feeds = 0;
+	mutable long    allocationsAtWarmup = 0;
+	mutable long    allocationsAtLast = 0;
+};
+
+static int TestRecord (const char* path, bool capturePayload)
+{
+	std::vector<uint8_t> audio(500, 0xa5);
+	std::vector<uint8_t> video(200 * 1024, 0xb5);
+	LG_EsRecorder recorder(new StubEsPlayer, path, capturePayload);
+	CHECK(recorder.IsOpen());
+	recorder.Load(LG_MediaInfo {});
+
+	for (int i = 0; i < kWarmup; ++i)
+		recorder.Feed(audio.data(), audio.size(), i, ES_AUDIO);
+
+	const long before = gAllocations;
+	for (int i = 0; i < kSamples; ++i) {
+		if (i % 2)
+			recorder.Feed(video.data(), video.size(), i, ES_VIDEO);
+		else
+			recorder.Feed(audio.data(), audio.size(), i, ES_AUDIO);
+	}
+	const long allocations = gAllocations - before;
+
+	printf("record (payload %d): %ld allocations for %d samples, budget %d per sample\n",
+		   capturePayload, allocations, kSamples, ALLOCATION_BUDGET_RECORD);
+	CHECK(allocations <= (long)ALLOCATION_BUDGET_RECORD * kSamples);
+	return 0;
+}
+
+static int TestReplay (const char* path, bool capturePayload)
+{
+	CountingEsPlayer player;
+	LG_EsReplayer replayer(path);
+	CHECK(replayer.IsOpen());
+	CHECK(replayer.Replay(player, false) == LG_SUCCESS);
+	CHECK(player.feeds == kWarmup + kSamples);
+
+	const long allocations = player.allocationsAtLast - player.allocationsAtWarmup;
+	printf("replay (payload %d): %ld allocations for %d samples, budget %d per sample\n",
+		   capturePayload, allocations, kSamples, ALLOCATION_BUDGET_REPLAY);
+	CHECK(allocations <= (long)ALLOCATION_BUDGET_REPLAY * kSamples);
+	return 0;
+}
+
+int main (int argc, char* argv[])
+{
+	const char* path = argc > 1 ? argv[1] : "allocation_test.log";
+
+	for (int capturePayload = 0; capturePayload < 2; ++capturePayload) {
+		CHECK(TestRecord(path, capturePayload) == 0);
+		CHECK(TestReplay(path, capturePayload) == 0);
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+/**
+* Copyright (c) 2020 LG Electronics, Inc.
+*
+* Unless otherwise specified or set forth in the NOTICE file, all content,
+* including all source code files and documentation files in this repository are:
+* Confidential computer software. Valid license from LG required for
+* possession, use or copying.
+*/
+
+/**
+ *@file         FeedContentionTest.cpp
+ *@brief        Feeds audio and video from two threads through LG_EsRecorder.
+ *@details      The stand-in player holds every video Feed() until the audio thread has fed its frames.\n
+ *              If the recorder held a lock across the forwarded Feed(), the video Feed() would time out.\n
+ *              The held Feed() has not written its record yet, so the test does not overlap writes to the log.
+ *              With payload capture it only checks that the forwarded call is not serialized.
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LG_EsRecorder.h"
+#include "StubEsPlayer.h"
+
+
+static const int kRounds = 20;
+static const int kAudioFrames = 50;
+static const auto kTimeout = std::chrono::seconds(5);
+
+/**
+ *@brief		A stand-in player whose video Feed() waits for the audio frames of the same round.
+ */
+class ContentionEsPlayer : public StubEsPlayer
+{
+public:
+	virtual int Feed (const uint8_t*, uint32_t, int64_t, estream_t type) const override
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (type == ES_AUDIO) {
+			++audioFrames;
+			changed.notify_all();
+			return LG_SUCCESS;
+		}
+
+		++videoFrames;
+		changed.notify_all();
+		const int wanted = videoFrames * kAudioFrames;
+		if (timeouts == 0 && !changed.wait_for(lock, kTimeout, [&] { return audioFrames >= wanted; }))
+			++timeouts;
+		return LG_SUCCESS;
+	}
+
+	mutable std::mutex                 mutex;
+	mutable std::condition_variable    changed;
+	mutable int                        audioFrames = 0;
+	mutable int                        videoFrames = 0;
+	mutable int                        timeouts = 0;
+};
+
+int main (int argc, char* argv[])
+{
+	const char* path = argc > 1 ? argv[1] : "feed_contention_test.log";
+
+	for (int capturePayload = 0; capturePayload < 2; ++capturePayload) {
+		ContentionEsPlayer* player = new ContentionEsPlayer;
+		LG_EsRecorder recorder(player, path, capturePayload);
+		CHECK(recorder.IsOpen());
+
+		const std::vector<uint8_t> video(200 * 1024, 0xb5);
+		const std::vector<uint8_t> audio(500, 0xa5);
+
+		std::thread videoFeeder([&] {
+			for (int i = 0; i < kRounds; ++i)
+				recorder.Feed(video.data(), video.size(), i, ES_VIDEO);
+		});
+		std::thread audioFeeder([&] {
+			for (int i = 0; i < kRounds; ++i) {
+				{
+					// feed while the forwarded video Feed() of this round is held by the player
+					std::unique_lock<std::mutex> lock(player->mutex);
+					player->changed.wait_for(lock, kTimeout, [&] { return player->videoFrames > i; });
+				}
+				for (int j = 0; j < kAudioFrames; ++j)
+					recorder.Feed(audio.data(), audio.size(), i * kAudioFrames + j, ES_AUDIO);
+			}
+		});
+		videoFeeder.join();
+		audioFeeder.join();
+
+		CHECK(player->timeouts == 0);
+		CHECK(player->videoFrames == kRounds);
+		CHECK(player->audioFrames == kRounds * kAudioFrames);
+		CHECK(recorder.IsOpen());
+
+		StubEsPlayer replayed;
+		LG_EsReplayer replayer(path);
+		CHECK(replayer.Replay(replayed, false) == LG_SUCCESS);
+		CHECK(replayed.calls == kRounds * (kAudioFrames + 1));
+	}
+	return 0;
+}
@@ -0,0 +1,171 @@
+/**
+* Copyright (c) 2020 LG Electronics, Inc.
+*
+* Unless otherwise specified or set forth in the NOTICE file, all content,
+* including all source code files and documentation files in this repository are:
+* Confidential computer software. Valid license from LG required for
+* possession, use or copying.
+*/
+
+/**
+ *@file         RecorderTest.cpp
+ *@brief        Records calls of a stand-in player and replays them, including damaged logs.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "LG_EsRecorder.h"
+#include "StubEsPlayer.h"
+
+
+static const char* kCalls = "LAVEPKZOFU";
+
+static int Record (const char* path, bool capturePayload)
+{
+	LG_EsRecorder recorder(new StubEsPlayer, path, capturePayload);
+	CHECK(recorder.IsOpen());
+
+	const uint8_t audio[4] = { 0xa0, 0xa1, 0xa2, 0xa3 };
+	const uint8_t video[8] = { 0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7 };
+	LG_MediaInfo mediaInfo = {};
+	mediaInfo.audio.codec = CODEC_FORMAT_AAC;
+
+	recorder.Load(mediaInfo);
+	recorder.Feed(audio, sizeof(audio), 100, ES_AUDIO);
+	recorder.Feed(video, sizeof(video), 200, ES_VIDEO);
+	recorder.Feed(video, sizeof(video), 300, ES_VIDEO, ENCRYPTION_MODE_AESCTR_CENC);
+	recorder.Play();
+	recorder.Seek(1000);
+	recorder.Pause();
+	recorder.PushEos();
+	recorder.Flush();
+	recorder.Unload();
+	return 0;
+}
+
+static std::vector<uint8_t> ReadFile (const char* path)
+{
+	std::vector<uint8_t> data;
+	FILE* file = fopen(path, "rb");
+	if (file) {
+		uint8_t buffer[4096];
+		size_t n;
+		while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			data.insert(data.end(), buffer, buffer + n);
+		fclose(file);
+	}
+	return data;
+}
+
+static void WriteFile (const char* path, const std::vector<uint8_t>& data, size_t size)
+{
+	FILE* file = fopen(path, "wb");
+	fwrite(data.data(), 1, size, file);
+	fclose(file);
+}
+
+static int TestRoundTrip (const char* path)
+{
+	for (int capturePayload = 0; capturePayload < 2; ++capturePayload) {
+		CHECK(Record(path, capturePayload) == 0);
+
+		StubEsPlayer player;
+		LG_EsReplayer replayer(path);
+		CHECK(replayer.IsOpen());
+		CHECK(replayer.Replay(player, false) == LG_SUCCESS);
+		CHECK(player.CallsAre(kCalls));
+		CHECK(player.lastSize == 8);
+		CHECK(player.lastPts == 300);
+		CHECK(player.lastData[0] == (capturePayload ? 0xb0 : 0));
+	}
+	return 0;
+}
+
+static int TestTruncatedTail (const char* path)
+{
+	CHECK(Record(path, true) == 0);
+	const std::vector<uint8_t> log = ReadFile(path);
+
+	// cut in the middle of the last record, as a killed process leaves it
+	WriteFile(path, log, log.size() - 3);
+
+	StubEsPlayer player;
+	LG_EsReplayer replayer(path);
+	CHECK(replayer.IsOpen());
+	CHECK(replayer.Replay(player, false) == LG_ERROR);
+	CHECK(player.CallsAre("LAVEPKZOF"));
+	return 0;
+}
+
+static int TestUnknownOp (const char* path)
+{
+	CHECK(Record(path, false) == 0);
+	std::vector<uint8_t> log = ReadFile(path);
+
+	// the op of the second record (Feed of audio)
+	size_t offset = sizeof(LG_EsRecordFileHeader);
+	uint32_t length;
+	memcpy(&length, log.data() + offset, sizeof(length));
+	offset += sizeof(length) + length;
+	log[offset + sizeof(length) + offsetof(LG_EsRecordHeader, op)] = 0xff;
+	WriteFile(path, log, log.size());
+
+	StubEsPlayer player;
+	LG_EsReplayer replayer(path);
+	CHECK(replayer.Replay(player, false) == LG_ERROR);
+	CHECK(player.CallsAre("L"));
+	return 0;
+}
+
+static int TestOtherVersion (const char* path)
+{
+	CHECK(Record(path, false) == 0);
+	std::vector<uint8_t> log = ReadFile(path);
+
+	const uint32_t version = LG_ESRECORD_VERSION + 1;
+	memcpy(log.data() + offsetof(LG_EsRecordFileHeader, version), &version, sizeof(version));
+	WriteFile(path, log, log.size());
+
+	LG_EsReplayer replayer(path);
+	CHECK(!replayer.IsOpen());
+	return 0;
+}
+
+static int TestRealTimeFromFirstCall (const char* path)
+{
+	{
+		LG_EsRecorder recorder(new StubEsPlayer, path);
+		CHECK(recorder.IsOpen());
+
+		// an idle recorder before the first call must not delay the replay
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		recorder.Play();
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		recorder.Pause();
+	}
+
+	StubEsPlayer player;
+	LG_EsReplayer replayer(path);
+	const auto start = std::chrono::steady_clock::now();
+	CHECK(replayer.Replay(player, true) == LG_SUCCESS);
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	CHECK(player.CallsAre("PZ"));
+	CHECK(elapsed >= std::chrono::milliseconds(100));
+	CHECK(elapsed < std::chrono::milliseconds(400));
+	return 0;
+}
+
+int main (int argc, char* argv[])
+{
+	const char* path = argc > 1 ? argv[1] : "recorder_test.log";
+
+	CHECK(TestRoundTrip(path) == 0);
+	CHECK(TestTruncatedTail(path) == 0);
+	CHECK(TestUnknownOp(path) == 0);
+	CHECK(TestOtherVersion(path) == 0);
+	CHECK(TestRealTimeFromFirstCall(path) == 0);
+	return 0;
+}
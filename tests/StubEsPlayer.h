@@ -0,0 +1,109 @@
+/**
+* Copyright (c) 2020 LG Electronics, Inc.
+*
+* Unless otherwise specified or set forth in the NOTICE file, all content,
+* including all source code files and documentation files in this repository are:
+* Confidential computer software. Valid license from LG required for
+* possession, use or copying.
+*/
+
+/**
+ *@file         StubEsPlayer.h
+ *@brief        This is a header file that defines a stand-in LG_EsPlayer for the host tests.
+ *@details      It keeps the calls it receives in a fixed array and never allocates memory,
+ *              so it can be driven by allocation counting tests.
+ */
+
+
+#ifndef STUB_ESPLAYER_H
+#define STUB_ESPLAYER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "LG_EsPlayer.h"
+
+
+#define CHECK(cond)                                                          \
+	do {                                                                     \
+		if (!(cond)) {                                                       \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			return 1;                                                        \
+		}                                                                    \
+	} while (0)
+
+
+/**
+ *@brief		The StubEsPlayer class is a LG_EsPlayer that only remembers its calls.
+ *@details		Each call is kept as one character:
+ *				L(oad) U(nload) A(udio feed) V(ideo feed) S(ubtitle feed) E(ncrypted feed) K(seek) P(lay) Z(pause) O(eos) F(lush)
+ */
+class StubEsPlayer : public LG_EsPlayer
+{
+public:
+	static const int kMaxCalls = 256;
+
+	virtual int SetMediaInfo (const LG_MediaInfo&) override { return LG_SUCCESS; }
+	virtual int Load () override { Call('L'); return LG_SUCCESS; }
+	virtual int Load (const LG_MediaInfo&) override { Call('L'); return LG_SUCCESS; }
+	virtual int Load (const LG_MediaInfo&, LG_EsPlayerCallback) override { Call('L'); return LG_SUCCESS; }
+	virtual int Unload () override { Call('U'); return LG_SUCCESS; }
+
+	virtual int Feed (const uint8_t *data, uint32_t size, int64_t pts, estream_t type) const override
+	{
+		Call(type == ES_VIDEO ? 'V' : type == ES_AUDIO ? 'A' : 'S');
+		lastData = data;
+		lastSize = size;
+		lastPts = pts;
+		return LG_SUCCESS;
+	}
+
+	virtual int Feed (const uint8_t *data, uint32_t size, int64_t pts, estream_t, encryption_t) const override
+	{
+		Call('E');
+		lastData = data;
+		lastSize = size;
+		lastPts = pts;
+		return LG_SUCCESS;
+	}
+
+	virtual int Play () override { Call('P'); return LG_SUCCESS; }
+	virtual int Pause () override { Call('Z'); return LG_SUCCESS; }
+	virtual int Seek (int) override { Call('K'); return LG_SUCCESS; }
+	virtual int PushEos () override { Call('O'); return LG_SUCCESS; }
+	virtual int Flush () const override { Call('F'); return LG_SUCCESS; }
+	virtual int64_t GetCurrentTime () const override { return lastPts; }
+	virtual int SetDisplayWindow (int, int, int, int) override { return LG_SUCCESS; }
+	virtual int SetCropVideoDisplayWindow (int, int, int, int, int, int, int, int) override { return LG_SUCCESS; }
+	virtual int Mute () override { return LG_SUCCESS; }
+	virtual int Unmute () override { return LG_SUCCESS; }
+
+	/**
+	 *@brief		Use this function to compare the received calls with the expected ones.
+	 *@return		returns true when the first calls are \p expected
+	 */
+	bool CallsAre (const char* expected) const
+	{
+		const int count = calls;
+		return count == (int)strlen(expected) && count <= kMaxCalls && memcmp(log, expected, count) == 0;
+	}
+
+	mutable std::atomic<int>    calls { 0 };
+	mutable const uint8_t*      lastData = nullptr;
+	mutable uint32_t            lastSize = 0;
+	mutable int64_t             lastPts = -1;
+
+protected:
+	void Call (char op) const
+	{
+		const int i = calls++;
+		if (i < kMaxCalls)
+			log[i] = op;
+	}
+
+	mutable char                log[kMaxCalls] = {};
+};
+
+#endif // STUB_ESPLAYER_H
@@ -0,0 +1,540 @@
+/**
+* Copyright (c) 2020 LG Electronics, Inc.
+*
+* Unless otherwise specified or set forth in the NOTICE file, all content,
+* including all source code files and documentation files in this repository are:
+* Confidential computer software. Valid license from LG required for
+* possession, use or copying.
+*/
+
+/**
+ *@file         LG_EsRecorder.h
+ *@brief        This is a header file that defines the recorder and replayer of LG_EsPlayer calls.
+ *@details      The recorder is a LG_EsPlayer which forwards every call to another LG_EsPlayer
+ *              and appends Load/Unload/Feed/Seek/Play/Pause/PushEos/Flush to a binary log.\n
+ *              The replayer maps such a log and drives any LG_EsPlayer with the same calls,
+ *              either at the original pace or as fast as possible.
+ */
+
+
+#ifndef LG_ESRECORDER_H
+#define LG_ESRECORDER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "LG_EsPlayer.h"
+
+
+/**
+ *@brief	Layout of the recorder log
+ *@details	The log starts with LG_EsRecordFileHeader followed by records.\n
+ *			Each record is a uint32_t length of the rest of the record,
+ *			LG_EsRecordHeader and \p size bytes of payload when LG_ESRECORD_FLAG_PAYLOAD is set.\n
+ *			All fields are stored in the host byte order.\n
+ *			LG_ESRECORD_VERSION is increased whenever an op is added or a payload layout changes,
+ *			and the replayer rejects logs of another version and records of unknown ops.\n
+ *			The recorder opens the log with O_LARGEFILE, so on a 32-bit target it keeps recording past 2 GB.
+ *			The replayer maps the whole log at once and rejects a log larger than SIZE_MAX,
+ *			on a 32-bit target a log also has to fit in the free address space of the process.
+ */
+#define LG_ESRECORD_MAGIC      "LGESREC"
+#define LG_ESRECORD_VERSION    1
+
+#ifdef O_LARGEFILE
+#define LG_ESRECORD_O_LARGEFILE    O_LARGEFILE
+#else
+#define LG_ESRECORD_O_LARGEFILE    0
+#endif
+
+
+/**
+ *@brief	The type of recorded call
+ */
+enum LG_ESRECORD_OP
+{
+	LG_ESRECORD_OP_LOAD = 1,      ///< Load(), payload is LG_MediaInfo
+	LG_ESRECORD_OP_UNLOAD,        ///< Unload()
+	LG_ESRECORD_OP_FEED,          ///< Feed()
+	LG_ESRECORD_OP_SEEK,          ///< Seek(), pts is the position in milliseconds
+	LG_ESRECORD_OP_PLAY,          ///< Play()
+	LG_ESRECORD_OP_PAUSE,         ///< Pause()
+	LG_ESRECORD_OP_PUSH_EOS,      ///< PushEos()
+	LG_ESRECORD_OP_FLUSH          ///< Flush()
+};
+
+
+/**
+ *@brief	Flags of a recorded call
+ */
+enum LG_ESRECORD_FLAG
+{
+	LG_ESRECORD_FLAG_PAYLOAD    = 0x01,   ///< payload follows the record header
+	LG_ESRECORD_FLAG_ENCRYPTION = 0x02    ///< Feed() was called with encryption_t
+};
+
+
+/**
+ *@brief	Header of the recorder log
+ */
+struct LG_EsRecordFileHeader
+{
+	char        magic[8];        ///< LG_ESRECORD_MAGIC
+	uint32_t    version;         ///< LG_ESRECORD_VERSION
+	uint32_t    flags;           ///< LG_ESRECORD_FLAG_PAYLOAD when payload is captured
+};
+
+
+/**
+ *@brief	Header of a recorded call
+ */
+struct LG_EsRecordHeader
+{
+	uint64_t    timestamp;       ///< monotonic time of the call since recording started (Unit: ns), see LG_EsRecorder
+	int64_t     pts;             ///< pts of Feed() or position of Seek()
+	uint32_t    size;            ///< size of fed data or payload
+	int32_t     result;          ///< return value of the call
+	uint8_t     op;              ///< LG_ESRECORD_OP
+	uint8_t     type;            ///< estream_t of Feed()
+	uint8_t     mode;            ///< encryption_t of Feed()
+	uint8_t     flags;           ///< LG_ESRECORD_FLAG
+	uint32_t    reserved;        ///< Reserved
+};
+
+
+/**
+ *@brief		The LG_EsRecorder class records the calls made on a LG_EsPlayer.
+ *@details		All calls are forwarded to the recorded player and their results are returned unchanged.\n
+ *				The recorder owns the recorded player and deletes it when it is deleted.\n
+ *				Each call is appended with a single writev() on a O_APPEND file and no lock is held across the forwarded call,
+ *				so recording does not hold a Feed() of one estream_t behind the forwarded Feed() of another.
+ *				The appends themselves are serialized by the kernel on the log file,
+ *				so when the fed data is captured a Feed() may wait for the record of a large frame fed from another thread.\n
+ *				\<NOTE\> A record is appended when its call returns, but its timestamp is taken when the call starts.
+ *				Records of calls made from different threads at the same time are in the order the calls returned,
+ *				so their timestamps may not be increasing. The replayer keeps the order of the log.\n
+ *				Recording a call does not allocate memory.
+ */
+class LG_EsRecorder : public LG_EsPlayer
+{
+public:
+	/**
+	 *@brief		Use this function to start recording a player.
+	 *@param		player [in] the player to record, must not be null.
+	 *@param		path [in] path of the log, an existing file is truncated.
+	 *@param		capturePayload [in] also write the fed data to the log.
+	 *@see			IsOpen
+	 */
+	LG_EsRecorder (LG_EsPlayer* player, const char* path, bool capturePayload = false)
+		: mPlayer(player)
+		, mCapturePayload(capturePayload)
+		, mStart(std::chrono::steady_clock::now())
+	{
+		mFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC | LG_ESRECORD_O_LARGEFILE, 0644);
+		if (mFd < 0)
+			return;
+
+		LG_EsRecordFileHeader header = {};
+		memcpy(header.magic, LG_ESRECORD_MAGIC, sizeof(LG_ESRECORD_MAGIC));
+		header.version = LG_ESRECORD_VERSION;
+		header.flags = capturePayload ? LG_ESRECORD_FLAG_PAYLOAD : 0;
+		if (write(mFd, &header, sizeof(header)) != sizeof(header)) {
+			close(mFd);
+			mFd = -1;
+		}
+	}
+
+	virtual ~LG_EsRecorder ()
+	{
+		if (mFd >= 0)
+			close(mFd);
+		delete mPlayer;
+	}
+
+	/**
+	 *@brief		Use this function to check that calls are being recorded.
+	 *@details		Recording stops after the first write to the log fails or is short,
+	 *				the log then ends with the records written before the failure.
+	 *@return		returns true when calls are being recorded
+	 */
+	bool IsOpen () const
+	{
+		return mFd >= 0 && !mFailed;
+	}
+
+	virtual int SetMediaInfo (const LG_MediaInfo& mediaInfo) override
+	{
+		mMediaInfo = mediaInfo;
+		return mPlayer->SetMediaInfo(mediaInfo);
+	}
+
+	virtual int Load () override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Load();
+		RecordLoad(now, result);
+		return result;
+	}
+
+	virtual int Load (const LG_MediaInfo& mediaInfo) override
+	{
+		const auto now = Now();
+		mMediaInfo = mediaInfo;
+		const int result = mPlayer->Load(mediaInfo);
+		RecordLoad(now, result);
+		return result;
+	}
+
+	virtual int Load (const LG_MediaInfo& mediaInfo, LG_EsPlayerCallback callback) override
+	{
+		const auto now = Now();
+		mMediaInfo = mediaInfo;
+		const int result = mPlayer->Load(mediaInfo, callback);
+		RecordLoad(now, result);
+		return result;
+	}
+
+	virtual int Unload () override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Unload();
+		Record(now, LG_ESRECORD_OP_UNLOAD, result);
+		return result;
+	}
+
+	virtual int Feed (const uint8_t *data, uint32_t size, int64_t pts, estream_t type) const override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Feed(data, size, pts, type);
+		RecordFeed(now, result, data, size, pts, type, ENCRYPTION_MODE_NONE, 0);
+		return result;
+	}
+
+	virtual int Feed (const uint8_t *data, uint32_t size, int64_t pts, estream_t type, encryption_t mode) const override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Feed(data, size, pts, type, mode);
+		RecordFeed(now, result, data, size, pts, type, mode, LG_ESRECORD_FLAG_ENCRYPTION);
+		return result;
+	}
+
+	virtual int Play () override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Play();
+		Record(now, LG_ESRECORD_OP_PLAY, result);
+		return result;
+	}
+
+	virtual int Pause () override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Pause();
+		Record(now, LG_ESRECORD_OP_PAUSE, result);
+		return result;
+	}
+
+	virtual int Seek (int ms) override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Seek(ms);
+		Record(now, LG_ESRECORD_OP_SEEK, result, ms);
+		return result;
+	}
+
+	virtual int PushEos () override
+	{
+		const auto now = Now();
+		const int result = mPlayer->PushEos();
+		Record(now, LG_ESRECORD_OP_PUSH_EOS, result);
+		return result;
+	}
+
+	virtual int Flush () const override
+	{
+		const auto now = Now();
+		const int result = mPlayer->Flush();
+		Record(now, LG_ESRECORD_OP_FLUSH, result);
+		return result;
+	}
+
+	virtual int64_t GetCurrentTime () const override
+	{
+		return mPlayer->GetCurrentTime();
+	}
+
+	virtual int SetDisplayWindow (int dispX = 0, int dispY = 0, int dispW = 0, int dispH = 0) override
+	{
+		return mPlayer->SetDisplayWindow(dispX, dispY, dispW, dispH);
+	}
+
+	virtual int SetCropVideoDisplayWindow(int cropX, int cropY, int cropW, int cropH,
+										  int dispX, int dispY, int dispW, int dispH) override
+	{
+		return mPlayer->SetCropVideoDisplayWindow(cropX, cropY, cropW, cropH, dispX, dispY, dispW, dispH);
+	}
+
+	virtual int Mute () override
+	{
+		return mPlayer->Mute();
+	}
+
+	virtual int Unmute () override
+	{
+		return mPlayer->Unmute();
+	}
+
+private:
+	uint64_t Now () const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count();
+	}
+
+	void Record (uint64_t timestamp, LG_ESRECORD_OP op, int result, int64_t pts = 0) const
+	{
+		LG_EsRecordHeader header = {};
+		header.timestamp = timestamp;
+		header.pts = pts;
+		header.result = result;
+		header.op = op;
+		Write(header, nullptr);
+	}
+
+	void RecordLoad (uint64_t timestamp, int result) const
+	{
+		LG_EsRecordHeader header = {};
+		header.timestamp = timestamp;
+		header.size = sizeof(mMediaInfo);
+		header.result = result;
+		header.op = LG_ESRECORD_OP_LOAD;
+		header.flags = LG_ESRECORD_FLAG_PAYLOAD;
+		Write(header, &mMediaInfo);
+	}
+
+	void RecordFeed (uint64_t timestamp, int result, const uint8_t *data, uint32_t size, int64_t pts,
+					 estream_t type, encryption_t mode, uint8_t flags) const
+	{
+		LG_EsRecordHeader header = {};
+		header.timestamp = timestamp;
+		header.pts = pts;
+		header.size = size;
+		header.result = result;
+		header.op = LG_ESRECORD_OP_FEED;
+		header.type = type;
+		header.mode = mode;
+		header.flags = flags;
+		if (mCapturePayload && data)
+			header.flags |= LG_ESRECORD_FLAG_PAYLOAD;
+		Write(header, data);
+	}
+
+	void Write (const LG_EsRecordHeader& header, const void* payload) const
+	{
+		if (mFd < 0 || mFailed)
+			return;
+
+		const bool hasPayload = header.flags & LG_ESRECORD_FLAG_PAYLOAD;
+		const uint32_t length = sizeof(header) + (hasPayload ? header.size : 0);
+		struct iovec iov[3] = {
+			{ const_cast<uint32_t*>(&length), sizeof(length) },
+			{ const_cast<LG_EsRecordHeader*>(&header), sizeof(header) },
+			{ const_cast<void*>(payload), hasPayload ? header.size : 0 },
+		};
+
+		if (writev(mFd, iov, hasPayload ? 3 : 2) != (ssize_t)(sizeof(length) + length))
+			mFailed = true;
+	}
+
+	LG_EsPlayer*                               mPlayer;
+	bool                                       mCapturePayload;
+	std::chrono::steady_clock::time_point      mStart;
+	LG_MediaInfo                               mMediaInfo = {};
+	int                                        mFd = -1;
+	mutable std::atomic<bool>                  mFailed { false };
+};
+
+
+/**
+ *@brief		The LG_EsReplayer class drives a LG_EsPlayer with the calls of a recorder log.
+ */
+class LG_EsReplayer
+{
+public:
+	/**
+	 *@brief		Use this function to map a log written by LG_EsRecorder.
+	 *@details		A log larger than SIZE_MAX or than the free address space is not mapped.
+	 *@param		path [in] path of the log
+	 *@see			IsOpen
+	 */
+	explicit LG_EsReplayer (const char* path)
+	{
+		const int fd = open(path, O_RDONLY | O_CLOEXEC | LG_ESRECORD_O_LARGEFILE);
+		if (fd < 0)
+			return;
+
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(LG_EsRecordFileHeader) &&
+			(uint64_t)st.st_size <= SIZE_MAX) {
+			void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr != MAP_FAILED) {
+				mData = static_cast<const uint8_t*>(addr);
+				mSize = st.st_size;
+			}
+		}
+		close(fd);
+
+		if (mData) {
+			LG_EsRecordFileHeader header;
+			memcpy(&header, mData, sizeof(header));
+			if (memcmp(header.magic, LG_ESRECORD_MAGIC, sizeof(LG_ESRECORD_MAGIC)) != 0 ||
+				header.version != LG_ESRECORD_VERSION) {
+				munmap(const_cast<uint8_t*>(mData), mSize);
+				mData = nullptr;
+				mSize = 0;
+			}
+		}
+	}
+
+	~LG_EsReplayer ()
+	{
+		if (mData)
+			munmap(const_cast<uint8_t*>(mData), mSize);
+	}
+
+	LG_EsReplayer (const LG_EsReplayer&) = delete;
+	LG_EsReplayer& operator= (const LG_EsReplayer&) = delete;
+
+	/**
+	 *@brief		Use this function to check that the log is mapped and valid.
+	 *@return		returns true when the log can be replayed
+	 */
+	bool IsOpen () const
+	{
+		return mData != nullptr;
+	}
+
+	/**
+	 *@brief		Use this function to replay the log on a player.
+	 *@details		Feed() records without payload are replayed with zero filled data of the recorded size.\n
+	 *				The log is checked and the zero filled data is allocated before the first call,
+	 *				so no memory is allocated by the replayer between calls to the player.\n
+	 *				The result of every call is ignored so the sequence of calls stays the same as recorded.\n
+	 *				A log cut short, e.g. by a killed process, is replayed up to its first invalid record.
+	 *@param		player [in] the player to drive
+	 *@param		realTime [in] true to keep the original timing from the earliest recorded call, false to replay as fast as possible.
+	 *				The time between creating the recorder and its first call is not replayed.
+	 *@return		returns LG_SUCCESS on success or LG_ERROR when the log is not valid or has an invalid record
+	 */
+	int Replay (LG_EsPlayer& player, bool realTime = true)
+	{
+		if (!mData)
+			return LG_ERROR;
+
+		LG_EsRecordHeader header;
+		const uint8_t* payload;
+		size_t end = sizeof(LG_EsRecordFileHeader);
+		size_t scratchSize = 0;
+		uint64_t first = UINT64_MAX;
+		while (end < mSize && Next(end, header, payload)) {
+			first = std::min(first, header.timestamp);
+			if (header.op == LG_ESRECORD_OP_FEED && !payload)
+				scratchSize = std::max<size_t>(scratchSize, header.size);
+		}
+		if (mScratch.size() < scratchSize)
+			mScratch.resize(scratchSize);
+
+		const auto start = std::chrono::steady_clock::now();
+		size_t offset = sizeof(LG_EsRecordFileHeader);
+		while (offset < end) {
+			Next(offset, header, payload);
+			if (realTime)
+				std::this_thread::sleep_until(start + std::chrono::nanoseconds(header.timestamp - first));
+			Dispatch(player, header, payload);
+		}
+		return end == mSize ? LG_SUCCESS : LG_ERROR;
+	}
+
+private:
+	bool Next (size_t& offset, LG_EsRecordHeader& header, const uint8_t*& payload) const
+	{
+		uint32_t length;
+		if (mSize - offset < sizeof(length) + sizeof(header))
+			return false;
+		memcpy(&length, mData + offset, sizeof(length));
+		memcpy(&header, mData + offset + sizeof(length), sizeof(header));
+		if (length < sizeof(header) || mSize - offset - sizeof(length) < length)
+			return false;
+
+		if (header.op < LG_ESRECORD_OP_LOAD || header.op > LG_ESRECORD_OP_FLUSH)
+			return false;
+		if (header.op == LG_ESRECORD_OP_LOAD &&
+			(!(header.flags & LG_ESRECORD_FLAG_PAYLOAD) || header.size != sizeof(LG_MediaInfo)))
+			return false;
+
+		payload = nullptr;
+		if (header.flags & LG_ESRECORD_FLAG_PAYLOAD) {
+			if (length - sizeof(header) < header.size)
+				return false;
+			payload = mData + offset + sizeof(length) + sizeof(header);
+		}
+		offset += sizeof(length) + length;
+		return true;
+	}
+
+	void Dispatch (LG_EsPlayer& player, const LG_EsRecordHeader& header, const uint8_t* payload)
+	{
+		switch (header.op) {
+		case LG_ESRECORD_OP_LOAD: {
+			LG_MediaInfo mediaInfo;
+			memcpy(&mediaInfo, payload, sizeof(mediaInfo));
+			player.Load(mediaInfo);
+			break;
+		}
+		case LG_ESRECORD_OP_UNLOAD:
+			player.Unload();
+			break;
+		case LG_ESRECORD_OP_FEED:
+			if (!payload)
+				payload = mScratch.data();
+			if (header.flags & LG_ESRECORD_FLAG_ENCRYPTION)
+				player.Feed(payload, header.size, header.pts, (estream_t)header.type, (encryption_t)header.mode);
+			else
+				player.Feed(payload, header.size, header.pts, (estream_t)header.type);
+			break;
+		case LG_ESRECORD_OP_SEEK:
+			player.Seek((int)header.pts);
+			break;
+		case LG_ESRECORD_OP_PLAY:
+			player.Play();
+			break;
+		case LG_ESRECORD_OP_PAUSE:
+			player.Pause();
+			break;
+		case LG_ESRECORD_OP_PUSH_EOS:
+			player.PushEos();
+			break;
+		case LG_ESRECORD_OP_FLUSH:
+			player.Flush();
+			break;
+		default:
+			break;
+		}
+	}
+
+	const uint8_t*           mData = nullptr;
+	size_t                   mSize = 0;
+	std::vector<uint8_t>     mScratch;
+};
+
+#endif // LG_ESRECORDER_H